@@ -0,0 +1,8 @@
+#!/bin/sh
+cd ${0%/*} || exit 1    # Run from this directory
+
+# strong scaling: fixed mesh
+python scalingBenchmark.py --mode strong --nProcs 1 2 4 8
+
+# weak scaling: constant number of cells per processor
+python scalingBenchmark.py --mode weak --nProcs 1 2 4 8
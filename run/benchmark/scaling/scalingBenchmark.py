@@ -0,0 +1,323 @@
+# -*- coding: utf-8 -*-
+"""Strong and weak scaling benchmark of the VoF solvers.
+
+Copies a case, sets the number of subdomains (and for weak scaling the
+resolution), adds the stageTimes function object and runs the Allrun of the
+case. The per step stage times in postProcessing/stageTimes/*/stageTimes.csv
+are reduced to
+
+    cells/s             sum of the cells over the steps / wall time
+    interfaceCells/s    sum of the interface cells over the steps / wall time
+
+and the average time and load imbalance (max/avg over the ranks) of every
+stage. Results:
+
+    <name>.csv           one row per run
+    <name>_stages.csv    one row per run and stage
+    scalingHistory.csv   run rows appended with the git version, so that the
+                         throughput can be compared between releases
+
+The resolution of weak scaling runs is set by nx, ny and nz of
+system/simulationParameter: every direction with more than one cell is
+refined by nProcs^(1/dim). Cases without simulationParameter (e.g. the
+run/benchmark cases) only support strong scaling.
+
+Usage:
+
+    python scalingBenchmark.py --mode strong --nProcs 1 2 4 8
+    python scalingBenchmark.py --mode weak --nProcs 1 2 4 8 \\
+        --case ../../../testsuite/surfaceTension/sinWave --endTime 1e-4
+"""
+import argparse
+import csv
+import datetime
+import glob
+import os
+import re
+import shutil
+import subprocess
+
+thisDir = os.path.dirname(os.path.abspath(__file__))
+repoDir = os.path.abspath(os.path.join(thisDir, "..", "..", ".."))
+defaultCase = os.path.join(
+    repoDir, "testsuite", "advection", "test-deformationSphere"
+)
+
+stageTimesFunction = """    stageTimes
+    {
+        type            stageTimes;
+        libs            ("libpostProcess.so");
+    }
+"""
+
+summaryColumns = [
+    "version", "date", "case", "mode", "nProcs", "nCells", "steps",
+    "wallTime", "cellsPerSec", "interfaceCellsPerSec", "efficiency",
+]
+
+
+def readEntry(fileName, key):
+    with open(fileName) as f:
+        match = re.search(
+            r"^\s*%s\s+([^;]+);" % re.escape(key), f.read(), re.MULTILINE
+        )
+    return match.group(1).strip() if match else None
+
+
+def setEntry(fileName, key, value):
+    with open(fileName) as f:
+        content = f.read()
+    entry = re.compile(r"^(\s*%s\s+)[^;]+;" % re.escape(key), re.MULTILINE)
+    if entry.search(content):
+        content = entry.sub(r"\g<1>%s;" % value, content, count=1)
+    else:
+        content += "\n%s %s;\n" % (key, value)
+    with open(fileName, "w") as f:
+        f.write(content)
+
+
+def addStageTimes(controlDict):
+    with open(controlDict) as f:
+        content = f.read()
+    functions = re.search(r"^functions\s*\{\s*\n", content, re.MULTILINE)
+    if functions:
+        pos = functions.end()
+        content = content[:pos] + stageTimesFunction + content[pos:]
+    else:
+        content += "\nfunctions\n{\n%s}\n" % stageTimesFunction
+    with open(controlDict, "w") as f:
+        f.write(content)
+
+
+def rewriteAllrun(allrun, nProcs):
+    """Run the solver in serial for one and with decomposePar otherwise"""
+    solver = re.compile(
+        r"^(\s*)(runApplication|runParallel)\s+\$\(getApplication\)"
+    )
+    lines = []
+    with open(allrun) as f:
+        for line in f:
+            if re.match(r"^\s*runApplication\s+decomposePar", line):
+                continue
+            match = solver.match(line)
+            if match:
+                indent = match.group(1)
+                if nProcs == 1:
+                    line = indent + "runApplication $(getApplication)\n"
+                else:
+                    line = (
+                        indent + "runApplication decomposePar\n"
+                        + indent + "runParallel $(getApplication)\n"
+                    )
+            lines.append(line)
+    with open(allrun, "w") as f:
+        f.writelines(lines)
+
+
+def resolution(case):
+    simParams = os.path.join(case, "system", "simulationParameter")
+    if not os.path.isfile(simParams):
+        return {}
+    res = {}
+    for key in ["nx", "ny", "nz"]:
+        value = readEntry(simParams, key)
+        if value is not None:
+            res[key] = int(value)
+    return res
+
+
+def prepareCase(baseCase, caseDir, mode, nProcs, endTime):
+    if os.path.isdir(caseDir):
+        shutil.rmtree(caseDir)
+    shutil.copytree(baseCase, caseDir, symlinks=True)
+
+    # results of previous runs of the base case
+    for path in glob.glob(os.path.join(caseDir, "processor*")) \
+            + [os.path.join(caseDir, "postProcessing")]:
+        if os.path.isdir(path):
+            shutil.rmtree(path)
+    for log in glob.glob(os.path.join(caseDir, "log.*")):
+        os.remove(log)
+
+    system = os.path.join(caseDir, "system")
+
+    if mode == "weak":
+        res = resolution(caseDir)
+        refined = [key for key, n in res.items() if n > 1]
+        if not refined:
+            raise RuntimeError(
+                "weak scaling requires nx, ny, nz in "
+                "system/simulationParameter of %s" % baseCase
+            )
+        factor = nProcs**(1.0/len(refined))
+        for key in refined:
+            setEntry(
+                os.path.join(system, "simulationParameter"),
+                key, int(round(res[key]*factor))
+            )
+
+    decomposeParDict = os.path.join(system, "decomposeParDict")
+    if not os.path.isfile(decomposeParDict):
+        shutil.copy(
+            os.path.join(defaultCase, "system", "decomposeParDict"),
+            decomposeParDict
+        )
+    setEntry(decomposeParDict, "numberOfSubdomains", nProcs)
+    setEntry(decomposeParDict, "method", "scotch")
+
+    controlDict = os.path.join(system, "controlDict")
+    if endTime is not None:
+        setEntry(controlDict, "endTime", endTime)
+    addStageTimes(controlDict)
+
+    rewriteAllrun(os.path.join(caseDir, "Allrun"), nProcs)
+
+
+def readStageTimes(caseDir, skipSteps):
+    files = glob.glob(
+        os.path.join(caseDir, "postProcessing", "stageTimes", "*",
+                     "stageTimes.csv")
+    )
+    if not files:
+        raise RuntimeError("no stageTimes.csv found in %s" % caseDir)
+
+    rows = []
+    for fileName in sorted(files):
+        with open(fileName) as f:
+            rows += list(csv.DictReader(f))
+
+    times = sorted({float(row["time"]) for row in rows})
+    measured = set(times[skipSteps:])
+    return [row for row in rows if float(row["time"]) in measured]
+
+
+def evaluate(rows):
+    steps = [row for row in rows if row["stage"] == "total"]
+    if not steps:
+        raise RuntimeError("no time steps measured")
+
+    # the wall time of a step is the time of the slowest rank
+    wallTime = sum(float(row["max"]) for row in steps)
+    summary = {
+        "nCells": int(steps[-1]["nCells"]),
+        "steps": len(steps),
+        "wallTime": wallTime,
+        "cellsPerSec": sum(int(row["nCells"]) for row in steps)/wallTime,
+        "interfaceCellsPerSec":
+            sum(int(row["nInterfaceCells"]) for row in steps)/wallTime,
+    }
+
+    stages = {}
+    for row in rows:
+        s = stages.setdefault(
+            row["stage"], {"calls": 0, "avg": 0.0, "max": 0.0}
+        )
+        s["calls"] += int(row["calls"])
+        s["avg"] += float(row["avg"])
+        s["max"] += float(row["max"])
+
+    for s in stages.values():
+        s["imbalance"] = s["max"]/s["avg"] if s["avg"] > 0 else 1.0
+        s["fraction"] = s["max"]/wallTime
+
+    return summary, stages
+
+
+def gitVersion():
+    try:
+        return subprocess.check_output(
+            ["git", "describe", "--always", "--dirty", "--tags"],
+            cwd=repoDir, stderr=subprocess.DEVNULL
+        ).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def writeCsv(fileName, columns, rows, append=False):
+    exists = os.path.isfile(fileName)
+    with open(fileName, "a" if append else "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=columns)
+        if not (append and exists):
+            writer.writeheader()
+        writer.writerows(rows)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--case", default=defaultCase,
+                        help="case to benchmark (default: %(default)s)")
+    parser.add_argument("--mode", choices=["strong", "weak"],
+                        default="strong")
+    parser.add_argument("--nProcs", type=int, nargs="+",
+                        default=[1, 2, 4, 8])
+    parser.add_argument("--endTime", default=None,
+                        help="overwrite endTime of the controlDict")
+    parser.add_argument("--skipSteps", type=int, default=1,
+                        help="time steps excluded from the measurement")
+    parser.add_argument("--runDir", default=os.path.join(thisDir, "Cases"))
+    parser.add_argument("--name", default=None,
+                        help="name of the result files")
+    args = parser.parse_args()
+
+    baseCase = os.path.abspath(args.case)
+    caseName = os.path.basename(baseCase.rstrip(os.sep))
+    name = args.name or "scaling_%s_%s" % (caseName, args.mode)
+    version = gitVersion()
+    date = datetime.date.today().isoformat()
+
+    runs = []
+    stageRows = []
+    for nProcs in sorted(args.nProcs):
+        caseDir = os.path.join(
+            args.runDir, "%s_%s_%d" % (caseName, args.mode, nProcs)
+        )
+        prepareCase(baseCase, caseDir, args.mode, nProcs, args.endTime)
+
+        print("running %s with %d processors" % (caseDir, nProcs))
+        subprocess.check_call(["./Allrun"], cwd=caseDir)
+
+        summary, stages = evaluate(readStageTimes(caseDir, args.skipSteps))
+        summary.update({
+            "version": version, "date": date, "case": caseName,
+            "mode": args.mode, "nProcs": nProcs,
+        })
+        runs.append(summary)
+
+        for stage, s in sorted(stages.items()):
+            stageRows.append(dict(nProcs=nProcs, stage=stage, **s))
+
+    # parallel efficiency relative to the smallest number of processors
+    ref = runs[0]
+    for run in runs:
+        if args.mode == "strong":
+            run["efficiency"] = (
+                ref["wallTime"]/ref["steps"]*ref["nProcs"]
+                / (run["wallTime"]/run["steps"]*run["nProcs"])
+            )
+        else:
+            run["efficiency"] = (
+                run["cellsPerSec"]/run["nProcs"]
+                / (ref["cellsPerSec"]/ref["nProcs"])
+            )
+
+    writeCsv(os.path.join(thisDir, name + ".csv"), summaryColumns, runs)
+    writeCsv(
+        os.path.join(thisDir, name + "_stages.csv"),
+        ["nProcs", "stage", "calls", "avg", "max", "imbalance", "fraction"],
+        stageRows
+    )
+    writeCsv(
+        os.path.join(thisDir, "scalingHistory.csv"), summaryColumns, runs,
+        append=True
+    )
+
+    for run in runs:
+        print(
+            "%(mode)s nProcs %(nProcs)d: %(cellsPerSec).4g cells/s, "
+            "%(interfaceCellsPerSec).4g interface cells/s, "
+            "efficiency %(efficiency).3f" % run
+        )
+
+
+if __name__ == "__main__":
+    main()
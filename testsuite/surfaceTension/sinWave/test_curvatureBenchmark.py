@@ -0,0 +1,107 @@
+import os
+import re
+import pytest
+import oftest
+import pandas as pd
+from oftest import run_reset_case
+
+
+# fitParaboloid benchmark: 1200 fits, generic 1e+06 fits/s, batched ...
+benchmark_line = re.compile(
+    r"fitParaboloid benchmark: (\d+) fits, generic ([\d.e+-]+) fits/s, "
+    r"batched ([\d.e+-]+) fits/s, speedup ([\d.e+-]+), "
+    r"max \|dK\| ([\d.e+-]+)"
+)
+
+
+def simMod(res, nRepeat=10):
+    dir_name = os.path.dirname(os.path.abspath(__file__))
+    filemod = {
+        "system/simulationParameter": [
+            ("STM", "fitParaboloid"),
+            ("nx", res),
+            ("ny", 3*res),
+            ("nz", 1),
+            ("benchmarkCurvature", nRepeat),
+        ],
+        "system/controlDict": [
+            ("endTime", 2e-5),
+        ]
+    }
+    meta_data = {"Res": res}
+    case_mod = oftest.Case_modifiers(filemod, dir_name, meta_data)
+    return case_mod
+
+
+def read_benchmark(log):
+    nFits = 0
+    genericTime = 0
+    batchedTime = 0
+    maxdK = 0
+    with open(log) as f:
+        for line in f:
+            match = benchmark_line.search(line)
+            if match:
+                n = int(match.group(1))
+                nFits += n
+                genericTime += n/float(match.group(2))
+                batchedTime += n/float(match.group(3))
+                maxdK = max(maxdK, float(match.group(5)))
+    return nFits, genericTime, batchedTime, maxdK
+
+
+parameters = [
+    simMod(32),
+    simMod(64),
+    simMod(128),
+]
+
+results = {
+    "Res": [],
+    "nFits": [],
+    "generic": [],
+    "batched": [],
+    "speedup": [],
+    "maxdK": [],
+}
+
+
+@pytest.mark.parametrize(
+    "run_reset_case",
+    parameters,
+    indirect=["run_reset_case"],
+    ids=[
+        "curvatureBenchmark32",
+        "curvatureBenchmark64",
+        "curvatureBenchmark128",
+    ]
+)
+def test_curvatureBenchmark(run_reset_case):
+
+    log = oftest.path_log()
+    assert oftest.case_status(log) == "completed"  # checks if run completes
+
+    nFits, genericTime, batchedTime, maxdK = read_benchmark(log)
+    assert nFits > 0
+
+    # fits per second of the previous and the batched implementation
+    results["Res"].append(run_reset_case.meta_data["Res"])
+    results["nFits"].append(nFits)
+    results["generic"].append(nFits/genericTime)
+    results["batched"].append(nFits/batchedTime)
+    results["speedup"].append(genericTime/batchedTime)
+    results["maxdK"].append(maxdK)
+
+    # both implementations solve the same least square problem:
+    # deviation relative to the inverse cell size (wavelength 0.003)
+    h = 0.003/run_reset_case.meta_data["Res"]
+    assert maxdK*h < 1e-6
+
+
+def test_benchmarkResults():
+    print("results", results)
+    dir_name = os.path.dirname(os.path.abspath(__file__))
+    res = pd.DataFrame(results)
+    res.to_csv(
+        os.path.join(dir_name, "results_curvatureBenchmark.csv"), index=False
+    )